@@ -0,0 +1,494 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_ASIOMQTTTRANSPORT_H
+#define GROWSTUDIO_ASIOMQTTTRANSPORT_H
+
+#include "MqttTransport.h"
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Minimal MQTT 3.1.1 client on top of asio. All networking runs on a single io_context thread:
+ * incoming packets are parsed in place from one reusable receive buffer and handed to the
+ * message handler as string_views, and outgoing packets are appended to a pending buffer that
+ * is flushed with one write per batch.
+ */
+class AsioMqttTransport : public MqttTransport
+{
+public:
+    AsioMqttTransport(const std::string& server, std::string clientID, std::chrono::seconds keepAlive = std::chrono::seconds{60})
+    : mClientID(std::move(clientID)), mKeepAlive{keepAlive},
+      mWork(asio::make_work_guard(mIo)), mResolver(mIo), mSocket(mIo), mPingTimer(mIo), mPingDeadline(mIo), mReconnectTimer(mIo)
+    {
+        std::string_view address{server};
+        if (const auto scheme = address.find("://"); scheme != std::string_view::npos) {
+            address.remove_prefix(scheme + 3);
+        }
+        if (const auto colon = address.rfind(':'); colon != std::string_view::npos) {
+            mHost = address.substr(0, colon);
+            mPort = address.substr(colon + 1);
+        }
+        else {
+            mHost = address;
+            mPort = "1883";
+        }
+        mReadBuffer.resize(readBufferInitialSize);
+    }
+
+    ~AsioMqttTransport() override
+    {
+        mWork.reset();
+        mIo.stop();
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+    }
+
+    void connect() override
+    {
+        std::cout << "Connecting to tcp://" << mHost << ':' << mPort << std::endl;
+        asio::post(mIo, [this]() { startConnect(); });
+        if (!mThread.joinable()) {
+            mThread = std::thread([this]() { mIo.run(); });
+        }
+    }
+
+    [[nodiscard]] bool isConnected() const override
+    {
+        return mConnected;
+    }
+
+    void publish(const std::string& topic, const std::string& message) override
+    {
+        if (!mConnected) {
+            return;
+        }
+
+        std::lock_guard lock{mWriteMutex};
+        const auto length = 2 + topic.size() + message.size();
+        mPending.push_back(static_cast<char>(PUBLISH << 4));
+        appendLength(mPending, length);
+        appendString(mPending, topic);
+        mPending.append(message);
+        scheduleFlush();
+    }
+
+    void subscribe(const std::string& topic) override
+    {
+        {
+            std::lock_guard lock{mTopicsMutex};
+            mTopics.push_back(topic);
+        }
+        if (mConnected) {
+            std::lock_guard lock{mWriteMutex};
+            appendSubscribe(std::span<const std::string>{&topic, 1});
+            scheduleFlush();
+        }
+    }
+
+    void onMessage(MessageHandler cb) override
+    {
+        mMessageHandler = std::move(cb);
+    }
+
+    void onConnected(ConnectedHandler cb) override
+    {
+        mConnectedHandler = std::move(cb);
+    }
+
+    void onConnectionLost(ConnectionLostHandler cb) override
+    {
+        mConnectionLostHandler = std::move(cb);
+    }
+
+private:
+    enum PacketType : std::uint8_t
+    {
+        CONNECT = 1, CONNACK, PUBLISH, PUBACK, PUBREC, PUBREL, PUBCOMP,
+        SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK, PINGREQ, PINGRESP, DISCONNECT
+    };
+
+    static constexpr std::size_t readBufferInitialSize{64 * 1024};
+    // Larger packets are treated as a protocol error instead of growing the receive buffer further
+    static constexpr std::size_t maxPacketSize{1024 * 1024};
+    static constexpr std::chrono::milliseconds reconnectDelay{2500};
+
+    std::string mHost;
+    std::string mPort;
+    std::string mClientID;
+    std::chrono::seconds mKeepAlive;
+
+    asio::io_context mIo;
+    asio::executor_work_guard<asio::io_context::executor_type> mWork;
+    asio::ip::tcp::resolver mResolver;
+    asio::ip::tcp::socket mSocket;
+    asio::steady_timer mPingTimer;
+    // Armed when PINGREQ is sent, cleared by PINGRESP
+    asio::steady_timer mPingDeadline;
+    bool mAwaitingPingResponse{false};
+    asio::steady_timer mReconnectTimer;
+    std::thread mThread;
+    std::atomic<bool> mConnected{false};
+    int mRetry{};
+    std::uint16_t mPacketID{};
+
+    // Receive side, only touched on the io thread
+    std::vector<char> mReadBuffer;
+    std::size_t mReadSize{};
+
+    // Send side. Any thread appends to mPending, the io thread swaps it into mWriting.
+    std::mutex mWriteMutex;
+    std::string mPending;
+    std::string mWriting;
+    bool mFlushScheduled{false};
+    bool mWriteInFlight{false};
+
+    std::mutex mTopicsMutex;
+    std::vector<std::string> mTopics;
+
+    MessageHandler mMessageHandler{[](auto, auto){}};
+    ConnectedHandler mConnectedHandler{[](){}};
+    ConnectionLostHandler mConnectionLostHandler{[](){}};
+
+    static void appendLength(std::string& out, std::size_t length)
+    {
+        do {
+            auto byte = static_cast<std::uint8_t>(length % 128);
+            length /= 128;
+            if (length > 0) {
+                byte |= 0x80;
+            }
+            out.push_back(static_cast<char>(byte));
+        } while (length > 0);
+    }
+
+    static void appendU16(std::string& out, std::uint16_t value)
+    {
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value & 0xff));
+    }
+
+    static void appendString(std::string& out, std::string_view str)
+    {
+        appendU16(out, static_cast<std::uint16_t>(str.size()));
+        out.append(str);
+    }
+
+    static std::uint16_t readU16(const char* data)
+    {
+        return static_cast<std::uint16_t>((static_cast<std::uint8_t>(data[0]) << 8) | static_cast<std::uint8_t>(data[1]));
+    }
+
+    // Requires mWriteMutex
+    void appendAck(PacketType type, std::uint16_t packetID)
+    {
+        mPending.push_back(static_cast<char>(type == PUBREL ? (PUBREL << 4) | 0x02 : type << 4));
+        mPending.push_back(2);
+        appendU16(mPending, packetID);
+    }
+
+    // Requires mWriteMutex
+    void appendSubscribe(std::span<const std::string> topics)
+    {
+        if (topics.empty()) {
+            return;
+        }
+        std::size_t length{2};
+        for (const auto& topic : topics) {
+            length += 2 + topic.size() + 1;
+        }
+        mPending.push_back(static_cast<char>((SUBSCRIBE << 4) | 0x02));
+        appendLength(mPending, length);
+        appendU16(mPending, nextPacketID());
+        for (const auto& topic : topics) {
+            appendString(mPending, topic);
+            mPending.push_back(static_cast<char>(QOS));
+        }
+    }
+
+    std::uint16_t nextPacketID()
+    {
+        if (++mPacketID == 0) {
+            mPacketID = 1;
+        }
+        return mPacketID;
+    }
+
+    // Requires mWriteMutex
+    void scheduleFlush()
+    {
+        if (!mFlushScheduled) {
+            mFlushScheduled = true;
+            asio::post(mIo, [this]() { flush(); });
+        }
+    }
+
+    void flush()
+    {
+        {
+            std::lock_guard lock{mWriteMutex};
+            mFlushScheduled = false;
+            if (mWriteInFlight || mPending.empty() || !mSocket.is_open()) {
+                return;
+            }
+            std::swap(mPending, mWriting);
+            mWriteInFlight = true;
+        }
+
+        asio::async_write(mSocket, asio::buffer(mWriting), [this](asio::error_code ec, std::size_t) {
+            mWriting.clear();
+            mWriteInFlight = false;
+            if (ec) {
+                handleError(ec);
+                return;
+            }
+            flush();
+        });
+    }
+
+    void startConnect()
+    {
+        mResolver.async_resolve(mHost, mPort, [this](asio::error_code ec, asio::ip::tcp::resolver::results_type endpoints) {
+            if (ec) {
+                connectFailed(ec);
+                return;
+            }
+            asio::async_connect(mSocket, endpoints, [this](asio::error_code ec, const asio::ip::tcp::endpoint&) {
+                if (ec) {
+                    connectFailed(ec);
+                    return;
+                }
+                mSocket.set_option(asio::ip::tcp::no_delay{true});
+                mReadSize = 0;
+                sendConnect();
+                read();
+            });
+        });
+    }
+
+    void sendConnect()
+    {
+        std::lock_guard lock{mWriteMutex};
+        mPending.clear();
+        const std::uint8_t flags{0x00}; // Persistent session, same as the paho backend
+        mPending.push_back(static_cast<char>(CONNECT << 4));
+        appendLength(mPending, 10 + 2 + mClientID.size());
+        appendString(mPending, "MQTT");
+        mPending.push_back(4); // Protocol level 3.1.1
+        mPending.push_back(static_cast<char>(flags));
+        appendU16(mPending, static_cast<std::uint16_t>(mKeepAlive.count()));
+        appendString(mPending, mClientID);
+        scheduleFlush();
+    }
+
+    void connectFailed(asio::error_code ec)
+    {
+        std::cout << "Connection attempt failed: " << ec.message() << std::endl;
+        if (++mRetry > N_RETRY_ATTEMPTS)
+            exit(1);
+        scheduleReconnect();
+    }
+
+    void scheduleReconnect()
+    {
+        asio::error_code ignored;
+        mSocket.close(ignored);
+        mReconnectTimer.expires_after(reconnectDelay);
+        mReconnectTimer.async_wait([this](asio::error_code ec) {
+            if (!ec) {
+                startConnect();
+            }
+        });
+    }
+
+    void handleError(asio::error_code ec)
+    {
+        if (ec == asio::error::operation_aborted || !mSocket.is_open()) {
+            return;
+        }
+
+        mPingTimer.cancel();
+        mPingDeadline.cancel();
+        mAwaitingPingResponse = false;
+        {
+            std::lock_guard lock{mWriteMutex};
+            mPending.clear();
+        }
+
+        if (mConnected.exchange(false)) {
+            mConnectionLostHandler();
+            std::cout << "\nConnection lost" << std::endl;
+            std::cout << "\tcause: " << ec.message() << std::endl;
+            std::cout << "Reconnecting..." << std::endl;
+            mRetry = 0;
+            scheduleReconnect();
+        }
+        else {
+            connectFailed(ec);
+        }
+    }
+
+    void startPing()
+    {
+        mPingTimer.expires_after(mKeepAlive / 2);
+        mPingTimer.async_wait([this](asio::error_code ec) {
+            if (ec) {
+                return;
+            }
+            {
+                std::lock_guard lock{mWriteMutex};
+                mPending.push_back(static_cast<char>(PINGREQ << 4));
+                mPending.push_back(0);
+                scheduleFlush();
+            }
+            if (!mAwaitingPingResponse) {
+                awaitPingResponse();
+            }
+            startPing();
+        });
+    }
+
+    // A broker that doesn't answer PINGREQ within the keepalive interval means a half-open connection
+    void awaitPingResponse()
+    {
+        mAwaitingPingResponse = true;
+        mPingDeadline.expires_after(mKeepAlive);
+        mPingDeadline.async_wait([this](asio::error_code ec) {
+            if (ec || !mAwaitingPingResponse) {
+                return;
+            }
+            handleError(asio::error::timed_out);
+        });
+    }
+
+    void read()
+    {
+        if (mReadSize == mReadBuffer.size()) {
+            mReadBuffer.resize(mReadBuffer.size() * 2);
+        }
+
+        mSocket.async_read_some(asio::buffer(mReadBuffer.data() + mReadSize, mReadBuffer.size() - mReadSize),
+                                [this](asio::error_code ec, std::size_t n) {
+            if (ec) {
+                handleError(ec);
+                return;
+            }
+            mReadSize += n;
+            parse();
+            if (mSocket.is_open()) {
+                read();
+            }
+        });
+    }
+
+    // Handles every complete packet in the receive buffer and moves a trailing partial one to the front
+    void parse()
+    {
+        const char* data = mReadBuffer.data();
+        std::size_t pos{};
+
+        while (mReadSize - pos >= 2 && mSocket.is_open()) {
+            std::size_t length{};
+            std::size_t header{1};
+            unsigned shift{};
+            bool complete{false};
+            while (pos + header < mReadSize && header <= 4) {
+                const auto byte = static_cast<std::uint8_t>(data[pos + header++]);
+                length |= static_cast<std::size_t>(byte & 0x7f) << shift;
+                shift += 7;
+                if ((byte & 0x80) == 0) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete && header > 4) {
+                // The remaining length field is at most four bytes long
+                handleError(asio::error::invalid_argument);
+                return;
+            }
+            if (complete && length > maxPacketSize) {
+                handleError(asio::error::message_size);
+                return;
+            }
+            if (!complete || pos + header + length > mReadSize) {
+                break;
+            }
+
+            handlePacket(static_cast<std::uint8_t>(data[pos]), std::string_view{data + pos + header, length});
+            pos += header + length;
+        }
+
+        if (pos > 0) {
+            std::memmove(mReadBuffer.data(), mReadBuffer.data() + pos, mReadSize - pos);
+            mReadSize -= pos;
+        }
+    }
+
+    void handlePacket(std::uint8_t fixedHeader, std::string_view body)
+    {
+        switch (fixedHeader >> 4) {
+            case CONNACK:
+                if (body.size() < 2 || body[1] != 0) {
+                    handleError(asio::error::connection_refused);
+                    return;
+                }
+                mRetry = 0;
+                mConnected = true;
+                mConnectedHandler();
+                {
+                    std::lock_guard topicsLock{mTopicsMutex};
+                    std::lock_guard writeLock{mWriteMutex};
+                    appendSubscribe(mTopics);
+                    scheduleFlush();
+                }
+                startPing();
+                break;
+            case PUBLISH: {
+                if (body.size() < 2) {
+                    return;
+                }
+                const int qos = (fixedHeader >> 1) & 0x03;
+                const std::size_t topicLength = readU16(body.data());
+                std::size_t offset = 2 + topicLength + (qos > 0 ? 2 : 0);
+                if (offset > body.size()) {
+                    return;
+                }
+                mMessageHandler(body.substr(2, topicLength), body.substr(offset));
+                if (qos > 0) {
+                    std::lock_guard lock{mWriteMutex};
+                    appendAck(qos == 1 ? PUBACK : PUBREC, readU16(body.data() + 2 + topicLength));
+                    scheduleFlush();
+                }
+                break;
+            }
+            case PUBREL:
+                if (body.size() >= 2) {
+                    std::lock_guard lock{mWriteMutex};
+                    appendAck(PUBCOMP, readU16(body.data()));
+                    scheduleFlush();
+                }
+                break;
+            case PINGRESP:
+                mAwaitingPingResponse = false;
+                mPingDeadline.cancel();
+                break;
+            default:
+                // SUBACK, PUBACK etc. need no action
+                break;
+        }
+    }
+};
+
+
+#endif //GROWSTUDIO_ASIOMQTTTRANSPORT_H
@@ -0,0 +1,310 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_COMPRESSEDSERIES_H
+#define GROWSTUDIO_COMPRESSEDSERIES_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <span>
+
+
+/**
+ * Append-only time series of float samples compressed Gorilla-style:
+ * timestamps are stored as delta-of-deltas and values as XORs against the
+ * previous value. Samples live in fixed-size blocks so the oldest data can be
+ * dropped a block at a time and decoding can start from any block.
+ */
+class CompressedSeries
+{
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Sample
+    {
+        Clock::time_point time;
+        float value;
+    };
+
+    explicit CompressedSeries(std::size_t maxBlocks = 256)
+    : mMaxBlocks{maxBlocks == 0 ? 1 : maxBlocks}
+    {}
+
+    void push(Clock::time_point time, float value)
+    {
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+
+        if (mBlocks.empty() || !mBlocks.back().hasRoom()) {
+            if (mBlocks.size() == mMaxBlocks) {
+                mSize -= mBlocks.front().count;
+                mBlocks.pop_front();
+            }
+            mBlocks.emplace_back();
+        }
+
+        mBlocks.back().append(ms, std::bit_cast<std::uint32_t>(value));
+        mLast = Sample{Clock::time_point{std::chrono::milliseconds{ms}}, value};
+        ++mSize;
+    }
+
+    void push(float value)
+    {
+        push(Clock::now(), value);
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return mSize;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return mSize == 0;
+    }
+
+    // Most recent sample. Only valid when the series is not empty.
+    [[nodiscard]] const Sample& back() const
+    {
+        return mLast;
+    }
+
+    // Bytes held by the compressed blocks, excluding container overhead.
+    [[nodiscard]] std::size_t bytes() const
+    {
+        return mBlocks.size() * sizeof(Block);
+    }
+
+    void clear()
+    {
+        mBlocks.clear();
+        mSize = 0;
+    }
+
+    // Calls f(const Sample&) for every stored sample, oldest first.
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (const auto& block : mBlocks) {
+            block.decode(f);
+        }
+    }
+
+    // Writes the values of the newest out.size() samples to out, oldest first, and returns how many were written.
+    // Only the blocks that contain those samples are decoded.
+    std::size_t copyLast(std::span<float> out) const
+    {
+        const std::size_t n = std::min(out.size(), mSize);
+        if (n == 0) {
+            return 0;
+        }
+
+        auto first = mBlocks.end();
+        std::size_t available{};
+        while (available < n) {
+            --first;
+            available += first->count;
+        }
+
+        std::size_t skip = available - n;
+        std::size_t written{};
+        for (auto it = first; it != mBlocks.end(); ++it) {
+            it->decode([&](const Sample& s) {
+                if (skip > 0) {
+                    --skip;
+                    return;
+                }
+                out[written++] = s.value;
+            });
+        }
+        return written;
+    }
+
+private:
+    static constexpr std::size_t blockBytes{512};
+    static constexpr std::size_t blockWords{blockBytes / sizeof(std::uint64_t)};
+    // Widest possible encoding of a single sample: 4 + 64 timestamp bits, 1 + 1 + 5 + 5 + 32 value bits.
+    static constexpr std::size_t maxSampleBits{112};
+    static constexpr std::uint8_t noWindow{0xff};
+
+    struct BitWriter
+    {
+        std::array<std::uint64_t, blockWords>& words;
+        std::uint32_t& pos;
+
+        void write(std::uint64_t value, unsigned nbits)
+        {
+            while (nbits > 0) {
+                const unsigned offset = pos % 64;
+                const unsigned n = std::min(nbits, 64u - offset);
+                const std::uint64_t chunk = (value >> (nbits - n)) & (n == 64 ? ~0ull : ((1ull << n) - 1));
+                words[pos / 64] |= chunk << (64 - offset - n);
+                pos += n;
+                nbits -= n;
+            }
+        }
+    };
+
+    struct BitReader
+    {
+        const std::array<std::uint64_t, blockWords>& words;
+        std::uint32_t pos{};
+
+        std::uint64_t read(unsigned nbits)
+        {
+            std::uint64_t value{};
+            while (nbits > 0) {
+                const unsigned offset = pos % 64;
+                const unsigned n = std::min(nbits, 64u - offset);
+                const std::uint64_t chunk = (words[pos / 64] >> (64 - offset - n)) & (n == 64 ? ~0ull : ((1ull << n) - 1));
+                value = (n == 64 ? 0 : value << n) | chunk;
+                pos += n;
+                nbits -= n;
+            }
+            return value;
+        }
+
+        bool bit()
+        {
+            const bool b = (words[pos / 64] >> (63 - pos % 64)) & 1u;
+            ++pos;
+            return b;
+        }
+    };
+
+    static std::int64_t signExtend(std::uint64_t value, unsigned nbits)
+    {
+        const std::uint64_t sign = 1ull << (nbits - 1);
+        return static_cast<std::int64_t>((value ^ sign) - sign);
+    }
+
+    struct Block
+    {
+        std::array<std::uint64_t, blockWords> words{};
+        std::int64_t firstTime{};
+        std::uint32_t firstValue{};
+        std::uint32_t bitPos{};
+        std::uint32_t count{};
+        // Encoder state, needed only while this block is the tail.
+        std::int64_t lastTime{};
+        std::int64_t lastDelta{};
+        std::uint32_t lastValue{};
+        std::uint8_t leading{noWindow};
+        std::uint8_t trailing{};
+
+        [[nodiscard]] bool hasRoom() const
+        {
+            return bitPos + maxSampleBits <= blockWords * 64;
+        }
+
+        void append(std::int64_t time, std::uint32_t value)
+        {
+            if (count++ == 0) {
+                firstTime = lastTime = time;
+                firstValue = lastValue = value;
+                return;
+            }
+
+            BitWriter out{words, bitPos};
+
+            const std::int64_t delta = time - lastTime;
+            const std::int64_t dod = delta - lastDelta;
+            if (dod == 0) {
+                out.write(0b0, 1);
+            } else if (dod >= -64 && dod <= 63) {
+                out.write(0b10, 2);
+                out.write(static_cast<std::uint64_t>(dod), 7);
+            } else if (dod >= -256 && dod <= 255) {
+                out.write(0b110, 3);
+                out.write(static_cast<std::uint64_t>(dod), 9);
+            } else if (dod >= -2048 && dod <= 2047) {
+                out.write(0b1110, 4);
+                out.write(static_cast<std::uint64_t>(dod), 12);
+            } else {
+                out.write(0b1111, 4);
+                out.write(static_cast<std::uint64_t>(dod), 64);
+            }
+            lastTime = time;
+            lastDelta = delta;
+
+            const std::uint32_t xored = value ^ lastValue;
+            lastValue = value;
+            if (xored == 0) {
+                out.write(0b0, 1);
+                return;
+            }
+
+            const auto lz = static_cast<std::uint8_t>(std::min(std::countl_zero(xored), 31));
+            const auto tz = static_cast<std::uint8_t>(std::countr_zero(xored));
+            if (leading != noWindow && lz >= leading && tz >= trailing) {
+                out.write(0b10, 2);
+                out.write(xored >> trailing, 32 - leading - trailing);
+            } else {
+                const unsigned length = 32 - lz - tz;
+                out.write(0b11, 2);
+                out.write(lz, 5);
+                out.write(length - 1, 5);
+                out.write(xored >> tz, length);
+                leading = lz;
+                trailing = tz;
+            }
+        }
+
+        template<typename F>
+        void decode(F&& f) const
+        {
+            if (count == 0) {
+                return;
+            }
+
+            std::int64_t time = firstTime;
+            std::int64_t delta{};
+            std::uint32_t value = firstValue;
+            unsigned lead{};
+            unsigned trail{};
+
+            f(Sample{Clock::time_point{std::chrono::milliseconds{time}}, std::bit_cast<float>(value)});
+
+            BitReader in{words};
+            for (std::uint32_t i = 1; i < count; ++i) {
+                std::int64_t dod{};
+                if (in.bit()) {
+                    if (!in.bit()) {
+                        dod = signExtend(in.read(7), 7);
+                    } else if (!in.bit()) {
+                        dod = signExtend(in.read(9), 9);
+                    } else if (!in.bit()) {
+                        dod = signExtend(in.read(12), 12);
+                    } else {
+                        dod = static_cast<std::int64_t>(in.read(64));
+                    }
+                }
+                delta += dod;
+                time += delta;
+
+                if (in.bit()) {
+                    if (in.bit()) {
+                        lead = static_cast<unsigned>(in.read(5));
+                        const auto length = static_cast<unsigned>(in.read(5)) + 1;
+                        trail = 32 - lead - length;
+                    }
+                    value ^= static_cast<std::uint32_t>(in.read(32 - lead - trail)) << trail;
+                }
+
+                f(Sample{Clock::time_point{std::chrono::milliseconds{time}}, std::bit_cast<float>(value)});
+            }
+        }
+    };
+
+    std::deque<Block> mBlocks;
+    std::size_t mMaxBlocks;
+    std::size_t mSize{};
+    Sample mLast{};
+};
+
+
+#endif //GROWSTUDIO_COMPRESSEDSERIES_H
@@ -0,0 +1,371 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_EVENTJOURNAL_H
+#define GROWSTUDIO_EVENTJOURNAL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * Bounded log of error events. Storage is a fixed ring of entries, the newest replacing the oldest.
+ * Device names and messages are interned into bounded tables whose entries are freed with the last
+ * event using them, so the tables follow the live entries and not the history. An event equal to one of the
+ * most recent entries within burstWindow only bumps that entry's count, so an error storm neither
+ * grows memory nor pushes out older history.
+ *
+ * Every entry links to the previous entry of the same device and of the same code, so filtered
+ * queries walk only the matching entries, newest first.
+ */
+class EventJournal
+{
+public:
+    using Clock = std::chrono::system_clock;
+    using Seq = std::uint64_t;
+
+    struct Event
+    {
+        Clock::time_point first;
+        Clock::time_point last;
+        std::uint32_t count{};
+        int code{};
+        std::uint32_t device{};
+        std::uint32_t message{};
+        // Previous entry with the same device / code, or noSeq
+        Seq prevDevice{};
+        Seq prevCode{};
+    };
+
+    struct Filter
+    {
+        std::optional<std::uint32_t> device;
+        std::optional<int> code;
+        Clock::time_point from{Clock::time_point::min()};
+        Clock::time_point to{Clock::time_point::max()};
+    };
+
+    // By default the string tables have a slot for every entry plus the overflow id, so strings only
+    // share the overflow id when maxStrings is set lower. Messages are cut to maxMessageLength, which
+    // bounds the tables at about capacity * maxMessageLength bytes.
+    explicit EventJournal(std::size_t capacity = 32768,
+                          Clock::duration burstWindow = std::chrono::seconds{1},
+                          std::optional<std::size_t> maxStrings = std::nullopt)
+    : mEvents(std::max<std::size_t>(capacity, 1)), mBurstWindow{burstWindow},
+      mDevices(maxStrings.value_or(mEvents.size() + 1)), mMessages(maxStrings.value_or(mEvents.size() + 1))
+    {}
+
+    void record(std::string_view device, int code, std::string_view message, Clock::time_point time = Clock::now())
+    {
+        message = message.substr(0, maxMessageLength);
+        ++mVersion;
+
+        // Bursts of the same event collapse into one counted entry. Only strings already in the tables can match.
+        const auto knownDevice = mDevices.peek(device);
+        const auto knownMessage = mMessages.peek(message);
+        const Seq lookback = knownDevice && knownMessage ? std::min<Seq>(size(), burstLookback) : 0;
+        for (Seq seq = mNext; seq > mNext - lookback; --seq) {
+            auto& event = at(seq - 1);
+            if (event.device == *knownDevice && event.code == code && event.message == *knownMessage && time - event.last <= mBurstWindow) {
+                event.last = std::max(event.last, time);
+                ++event.count;
+                return;
+            }
+        }
+
+        if (size() == mEvents.size()) {
+            const auto& oldest = at(mFirst);
+            release(mDeviceChains, oldest.device);
+            release(mCodeChains, oldest.code);
+            mDevices.release(oldest.device);
+            mMessages.release(oldest.message);
+            ++mFirst;
+        }
+
+        // After the eviction, so the oldest entry's strings are free for reuse
+        const auto deviceID = mDevices.acquire(device);
+        const auto messageID = mMessages.acquire(message);
+        auto& deviceChain = chain(mDeviceChains, deviceID);
+        auto& codeChain = chain(mCodeChains, code);
+        const Seq seq = mNext++;
+        at(seq) = Event{time, time, 1, code, deviceID, messageID, deviceChain.tail, codeChain.tail};
+        deviceChain.tail = seq;
+        ++deviceChain.size;
+        codeChain.tail = seq;
+        ++codeChain.size;
+    }
+
+    // Fills out with the sequence numbers of matching entries, newest first. Reuses out's capacity.
+    void query(const Filter& filter, std::vector<Seq>& out) const
+    {
+        out.clear();
+
+        const Chain* deviceChain = filter.device ? findChain(mDeviceChains, *filter.device) : nullptr;
+        const Chain* codeChain = filter.code ? findChain(mCodeChains, *filter.code) : nullptr;
+        if ((filter.device && !deviceChain) || (filter.code && !codeChain)) {
+            return;
+        }
+
+        // Walk the shortest list of candidates and check the remaining conditions on each
+        enum class Walk { All, Device, Code } walk{Walk::All};
+        Seq seq = newestBefore(filter.to);
+        if (deviceChain && (!codeChain || deviceChain->size <= codeChain->size)) {
+            walk = Walk::Device;
+            seq = deviceChain->tail;
+        }
+        else if (codeChain) {
+            walk = Walk::Code;
+            seq = codeChain->tail;
+        }
+
+        while (seq != noSeq && seq >= mFirst) {
+            const auto& event = at(seq);
+            if (event.first < filter.from) {
+                break;
+            }
+            if (event.first <= filter.to &&
+                (!filter.device || event.device == *filter.device) &&
+                (!filter.code || event.code == *filter.code)) {
+                out.push_back(seq);
+            }
+
+            switch (walk) {
+                case Walk::All: seq = seq == mFirst ? noSeq : seq - 1; break;
+                case Walk::Device: seq = event.prevDevice; break;
+                case Walk::Code: seq = event.prevCode; break;
+            }
+        }
+    }
+
+    [[nodiscard]] const Event& event(Seq seq) const
+    {
+        return at(seq);
+    }
+
+    // Nullptr when empty
+    [[nodiscard]] const Event* latest() const
+    {
+        return size() == 0 ? nullptr : &at(mNext - 1);
+    }
+
+    [[nodiscard]] std::string_view device(const Event& event) const
+    {
+        return mDevices.get(event.device);
+    }
+
+    [[nodiscard]] std::string_view message(const Event& event) const
+    {
+        return mMessages.get(event.message);
+    }
+
+    // Nullopt when no entry refers to the device
+    [[nodiscard]] std::optional<std::uint32_t> deviceID(std::string_view device) const
+    {
+        return mDevices.find(device);
+    }
+
+    // Calls f(std::string_view name) for every device that has entries, including the overflow entry if used
+    template<typename F>
+    void forEachDevice(F&& f) const
+    {
+        mDevices.forEach(f);
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return static_cast<std::size_t>(mNext - mFirst);
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return mEvents.size();
+    }
+
+    // Changes whenever an event is recorded, including bursts folded into an existing entry
+    [[nodiscard]] std::uint64_t version() const
+    {
+        return mVersion;
+    }
+
+private:
+    static constexpr Seq noSeq{std::numeric_limits<Seq>::max()};
+    static constexpr Seq burstLookback{16};
+    static constexpr std::size_t maxMessageLength{256};
+
+    // Reference counted strings. An id stays valid until every acquire() of it has been released,
+    // then its slot is reused. When all slots are taken new strings share a single overflow id.
+    class StringTable
+    {
+    public:
+        explicit StringTable(std::size_t maxStrings)
+        : mMax{std::max<std::size_t>(maxStrings, 2)}
+        {
+            mStrings.reserve(mMax);
+            mRefs.reserve(mMax);
+            mIndex.reserve(mMax);
+            mFree.reserve(mMax);
+            mStrings.emplace_back("(too many distinct values)");
+            mRefs.push_back(0);
+            mIndex.emplace(mStrings.front(), overflow);
+        }
+
+        // mIndex refers into mStrings
+        StringTable(const StringTable&) = delete;
+        StringTable& operator=(const StringTable&) = delete;
+
+        std::uint32_t acquire(std::string_view str)
+        {
+            auto id = find(str);
+            if (!id) {
+                if (!mFree.empty()) {
+                    id = mFree.back();
+                    mFree.pop_back();
+                    mStrings[*id] = str;
+                }
+                else if (mStrings.size() < mMax) {
+                    id = static_cast<std::uint32_t>(mStrings.size());
+                    mStrings.emplace_back(str);
+                    mRefs.push_back(0);
+                }
+                else {
+                    id = overflow;
+                }
+                if (*id != overflow) {
+                    // Keys point into mStrings, which never reallocates thanks to the reserve above
+                    mIndex.emplace(mStrings[*id], *id);
+                }
+            }
+            ++mRefs[*id];
+            return *id;
+        }
+
+        // The id acquire() would return, without taking it. Nullopt when the string would get a new id.
+        [[nodiscard]] std::optional<std::uint32_t> peek(std::string_view str) const
+        {
+            if (const auto id = find(str)) {
+                return id;
+            }
+            if (mFree.empty() && mStrings.size() == mMax) {
+                return overflow;
+            }
+            return std::nullopt;
+        }
+
+        void release(std::uint32_t id)
+        {
+            if (--mRefs[id] > 0 || id == overflow) {
+                return;
+            }
+            mIndex.erase(mStrings[id]);
+            mStrings[id].clear();
+            mFree.push_back(id);
+        }
+
+        [[nodiscard]] std::optional<std::uint32_t> find(std::string_view str) const
+        {
+            const auto it = mIndex.find(str);
+            return it == mIndex.end() ? std::nullopt : std::optional{it->second};
+        }
+
+        [[nodiscard]] std::string_view get(std::uint32_t id) const
+        {
+            return mStrings[id];
+        }
+
+        // Calls f(std::string_view) for every string in use
+        template<typename F>
+        void forEach(F&& f) const
+        {
+            for (std::size_t id = 0; id < mStrings.size(); ++id) {
+                if (mRefs[id] > 0) {
+                    f(std::string_view{mStrings[id]});
+                }
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t overflow{0};
+        std::size_t mMax;
+        std::vector<std::string> mStrings;
+        std::vector<std::uint32_t> mRefs;
+        std::vector<std::uint32_t> mFree;
+        std::unordered_map<std::string_view, std::uint32_t> mIndex;
+    };
+
+    struct Chain
+    {
+        Seq tail{noSeq};
+        std::size_t size{};
+    };
+
+    template<typename Key>
+    static Chain& chain(std::unordered_map<Key, Chain>& chains, Key key)
+    {
+        return chains[key];
+    }
+
+    // Drops a chain once its last entry is evicted, so the number of chains never exceeds the capacity
+    template<typename Key>
+    static void release(std::unordered_map<Key, Chain>& chains, Key key)
+    {
+        const auto it = chains.find(key);
+        if (it != chains.end() && --it->second.size == 0) {
+            chains.erase(it);
+        }
+    }
+
+    template<typename Key>
+    static const Chain* findChain(const std::unordered_map<Key, Chain>& chains, Key key)
+    {
+        const auto it = chains.find(key);
+        return it == chains.end() || it->second.size == 0 ? nullptr : &it->second;
+    }
+
+    Event& at(Seq seq)
+    {
+        return mEvents[seq % mEvents.size()];
+    }
+
+    [[nodiscard]] const Event& at(Seq seq) const
+    {
+        return mEvents[seq % mEvents.size()];
+    }
+
+    // Newest entry that started at or before time, found by binary search over the ring
+    [[nodiscard]] Seq newestBefore(Clock::time_point time) const
+    {
+        Seq lo{mFirst};
+        Seq hi{mNext};
+        while (lo < hi) {
+            const Seq mid = lo + (hi - lo) / 2;
+            if (at(mid).first <= time) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo == mFirst ? noSeq : lo - 1;
+    }
+
+    std::vector<Event> mEvents;
+    Seq mFirst{};
+    Seq mNext{};
+    std::uint64_t mVersion{};
+    Clock::duration mBurstWindow;
+    StringTable mDevices;
+    StringTable mMessages;
+    std::unordered_map<std::uint32_t, Chain> mDeviceChains;
+    std::unordered_map<int, Chain> mCodeChains;
+};
+
+
+#endif //GROWSTUDIO_EVENTJOURNAL_H
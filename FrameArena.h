@@ -0,0 +1,107 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_FRAMEARENA_H
+#define GROWSTUDIO_FRAMEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fmt/format.h>
+
+
+/**
+ * Linear allocator for data that only lives until the end of the current frame, such as ImGui labels.
+ * MainApp resets it once per frame. Requests that don't fit go to an overflow chunk, and on the next
+ * reset the main buffer grows to cover them, so after a few frames no more heap allocations happen.
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t capacity = 64 * 1024)
+    : mBuffer(std::make_unique<std::byte[]>(capacity)), mCapacity{capacity}
+    {}
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        const auto base = reinterpret_cast<std::uintptr_t>(mBuffer.get());
+        const auto aligned = (base + mOffset + alignment - 1) & ~(alignment - 1);
+        if (aligned + size <= base + mCapacity) {
+            mOffset = aligned + size - base;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        auto& chunk = mOverflow.emplace_back(std::make_unique<std::byte[]>(size + alignment));
+        mOverflowBytes += size + alignment;
+        const auto chunkBase = reinterpret_cast<std::uintptr_t>(chunk.get());
+        return reinterpret_cast<void*>((chunkBase + alignment - 1) & ~(alignment - 1));
+    }
+
+    // Uninitialized storage for n objects of T
+    template<typename T>
+    std::span<T> allocate(std::size_t n)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        return {static_cast<T*>(allocate(n * sizeof(T), alignof(T))), n};
+    }
+
+    // Null terminated copy of str
+    const char* copy(std::string_view str)
+    {
+        auto out = allocate<char>(str.size() + 1);
+        std::memcpy(out.data(), str.data(), str.size());
+        out.back() = '\0';
+        return out.data();
+    }
+
+    // Null terminated result of fmt::format
+    template<typename... Args>
+    const char* format(fmt::format_string<const Args&...> fmt, const Args&... args)
+    {
+        const auto size = fmt::formatted_size(fmt, args...);
+        auto out = allocate<char>(size + 1);
+        fmt::format_to(out.data(), fmt, args...);
+        out.back() = '\0';
+        return out.data();
+    }
+
+    void reset()
+    {
+        if (!mOverflow.empty()) {
+            mCapacity += mOverflowBytes;
+            mBuffer = std::make_unique<std::byte[]>(mCapacity);
+            mOverflow.clear();
+            mOverflowBytes = 0;
+        }
+        mOffset = 0;
+    }
+
+    [[nodiscard]] std::size_t used() const
+    {
+        return mOffset + mOverflowBytes;
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return mCapacity;
+    }
+
+private:
+    std::unique_ptr<std::byte[]> mBuffer;
+    std::size_t mCapacity;
+    std::size_t mOffset{};
+    std::vector<std::unique_ptr<std::byte[]>> mOverflow;
+    std::size_t mOverflowBytes{};
+};
+
+
+#endif //GROWSTUDIO_FRAMEARENA_H
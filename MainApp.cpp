@@ -5,10 +5,86 @@
 #include "MainApp.h"
 #include "imgui-SFML.h"
 #include <SFML/Window/Event.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
 
 
 static constexpr int fps{144};
 
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+// Every global operator new on the GUI thread is counted so run() can check steady-state frames.
+// Network threads are not counted.
+static thread_local std::size_t allocationCount{};
+static constexpr std::size_t allocationCheckWarmupFrames{fps * 2};
+
+// Allocations of the checked frames, split by the part of the loop that made them.
+// Any allocation in the GUI pass fails the check. Update and render allocations are only reported:
+// onUpdate() stores telemetry, which grows CompressedSeries and EventJournal by design, and the
+// render pass belongs to SFML. Those are printed once per second of frames when nonzero.
+struct AllocationReport
+{
+    std::size_t frames{};
+    std::size_t allocatingFrames{};
+    std::size_t update{};
+    std::size_t render{};
+
+    void add(std::size_t frame, std::size_t updateCount, std::size_t guiCount, std::size_t renderCount)
+    {
+        if (guiCount > 0) {
+            throw std::runtime_error("Allocation check: GUI pass of frame " + std::to_string(frame) + " performed " +
+                                     std::to_string(guiCount) + " heap allocations");
+        }
+
+        ++frames;
+        if (updateCount + renderCount > 0) {
+            ++allocatingFrames;
+        }
+        update += updateCount;
+        render += renderCount;
+
+        if (frames == fps) {
+            if (allocatingFrames > 0) {
+                std::cerr << "Allocation check: " << allocatingFrames << " of " << frames << " frames allocated"
+                          << " (update " << update << ", render " << render << ")" << std::endl;
+            }
+            *this = AllocationReport{};
+        }
+    }
+};
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
 MainApp::MainApp()
         : mWindow(sf::VideoMode(640, 480), "Application")
 {
@@ -28,26 +104,53 @@ MainApp::~MainApp()
 void MainApp::run()
 {
     sf::Clock deltaClock;
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+    std::size_t frame{};
+    AllocationReport allocationReport;
+#endif
 
     while (mWindow.isOpen())
     {
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+        const auto frameStart = allocationCount;
+#endif
+        [[maybe_unused]] bool hadEvents{false};
         sf::Event event{};
         while (mWindow.pollEvent(event))
         {
+            hadEvents = true;
             ImGui::SFML::ProcessEvent(mWindow, event);
             if (event.type == sf::Event::Closed) {
                 mWindow.close();
             }
         }
 
+        for (auto& plugin : mPlugins) {
+            plugin->onUpdate();
+        }
+
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+        const auto updateEnd = allocationCount;
+#endif
         const auto dt = deltaClock.restart();
         ImGui::SFML::Update(mWindow, dt);
+        mFrameArena.reset();
         for (auto& plugin : mPlugins) {
-            plugin->onGUI();
+            plugin->onGUI(mFrameArena);
         }
 
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+        const auto guiEnd = allocationCount;
+#endif
         mWindow.clear();
         ImGui::SFML::Render(mWindow);
         mWindow.display();
+
+#ifdef GROWSTUDIO_ALLOCATION_CHECK
+        // Input legitimately allocates (text fields, opening windows), so only idle frames are checked
+        if (++frame > allocationCheckWarmupFrames && !hadEvents) {
+            allocationReport.add(frame, updateEnd - frameStart, guiEnd - updateEnd, allocationCount - guiEnd);
+        }
+#endif
     }
 }
@@ -9,6 +9,7 @@
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Window/Event.hpp>
 #include "Plugin.h"
+#include "FrameArena.h"
 #include <vector>
 
 class MainApp
@@ -19,6 +20,7 @@ public:
     void run();
 private:
     sf::RenderWindow mWindow;
+    FrameArena mFrameArena;
     std::vector<std::unique_ptr<Plugin>> mPlugins;
 };
 
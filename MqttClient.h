@@ -7,15 +7,12 @@
 
 #include <string>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <mqtt/async_client.h>
-
-
-const std::string telemetryTopic("ReservoirController/telemetry");
-const std::string responseTopic("ReservoirController/rpc/response");
-const std::string requestTopic("ReservoirController/rpc/request");
-
-const int	QOS = 1;
-const int	N_RETRY_ATTEMPTS = 5;
+#include "MqttTransport.h"
+#include "AsioMqttTransport.h"
 
 
 
@@ -46,10 +43,6 @@ public:
     action_listener(const std::string& name) : name_(name) {}
 };
 
-using MessageHandler = std::function<void(mqtt::const_message_ptr)>;
-using ConnectedHandler = std::function<void()>;
-using ConnectionLostHandler = std::function<void()>;
-
 /////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -72,7 +65,11 @@ private:
     // An action listener to display the result of actions.
     action_listener subListener_;
 
-    MessageHandler mMessageHandler{[](auto){}};
+    // Topics to (re)subscribe on every connect
+    std::mutex topicsMutex_;
+    std::vector<std::string> topics_;
+
+    MessageHandler mMessageHandler{[](auto, auto){}};
     ConnectedHandler mConnectedHandler{[](){}};
     ConnectionLostHandler mConnectionLostHandler{[](){}};
 
@@ -108,8 +105,10 @@ private:
     // (Re)connection success
     void connected(const std::string& cause) override {
         mConnectedHandler();
-        cli_.subscribe(telemetryTopic, QOS, nullptr, subListener_);
-        cli_.subscribe(responseTopic, QOS, nullptr, subListener_);
+        std::lock_guard lock{topicsMutex_};
+        for (const auto& topic : topics_) {
+            cli_.subscribe(topic, QOS, nullptr, subListener_);
+        }
     }
 
     // Callback for when the connection is lost.
@@ -128,7 +127,7 @@ private:
 
     // Callback for when a message arrives.
     void message_arrived(mqtt::const_message_ptr msg) override {
-        mMessageHandler(msg);
+        mMessageHandler(msg->get_topic(), msg->get_payload());
     }
 
     void delivery_complete(mqtt::delivery_token_ptr token) override {}
@@ -137,6 +136,11 @@ public:
     callback(mqtt::async_client& cli, mqtt::connect_options& connOpts)
             : nretry_(0), cli_(cli), connOpts_(connOpts), subListener_("Subscription") {}
 
+    void addTopic(const std::string& topic) {
+        std::lock_guard lock{topicsMutex_};
+        topics_.push_back(topic);
+    }
+
     void onMessage(MessageHandler h) {
         mMessageHandler = std::move(h);
     }
@@ -151,14 +155,14 @@ public:
 };
 
 
-class MqttClient
+class PahoMqttTransport : public MqttTransport
 {
 public:
-    MqttClient(const std::string& server, const std::string& clientID)
+    PahoMqttTransport(const std::string& server, const std::string& clientID)
     : mClient(server, clientID), mCb(mClient, mConnOpts)
     {}
 
-    void connect()
+    void connect() override
     {
         mConnOpts.set_clean_session(false);
         mClient.set_callback(mCb);
@@ -167,32 +171,35 @@ public:
         mClient.connect(mConnOpts, nullptr, mCb);
     }
 
-    bool isConnected() const
+    [[nodiscard]] bool isConnected() const override
     {
         return mClient.is_connected();
     }
 
-    void publish(const std::string& topic, const std::string& message)
+    void publish(const std::string& topic, const std::string& message) override
     {
         mClient.publish(topic, message);
     }
 
-    void subscribe(const std::string& topic)
+    void subscribe(const std::string& topic) override
     {
-        mClient.subscribe(topic, QOS);
+        mCb.addTopic(topic);
+        if (mClient.is_connected()) {
+            mClient.subscribe(topic, QOS);
+        }
     }
 
-    void onMessage(MessageHandler cb)
+    void onMessage(MessageHandler cb) override
     {
         mCb.onMessage(std::move(cb));
     }
 
-    void onConnected(ConnectedHandler cb)
+    void onConnected(ConnectedHandler cb) override
     {
         mCb.onConnected(std::move(cb));
     }
 
-    void onConnectionLost(ConnectionLostHandler cb)
+    void onConnectionLost(ConnectionLostHandler cb) override
     {
         mCb.onConnectionLost(std::move(cb));
     }
@@ -203,4 +210,56 @@ private:
 };
 
 
+class MqttClient
+{
+public:
+    MqttClient(const std::string& server, const std::string& clientID, MqttBackend backend = MqttBackend::Paho)
+    {
+        if (backend == MqttBackend::Asio) {
+            mTransport = std::make_unique<AsioMqttTransport>(server, clientID);
+        }
+        else {
+            mTransport = std::make_unique<PahoMqttTransport>(server, clientID);
+        }
+    }
+
+    void connect()
+    {
+        mTransport->connect();
+    }
+
+    bool isConnected() const
+    {
+        return mTransport->isConnected();
+    }
+
+    void publish(const std::string& topic, const std::string& message)
+    {
+        mTransport->publish(topic, message);
+    }
+
+    void subscribe(const std::string& topic)
+    {
+        mTransport->subscribe(topic);
+    }
+
+    void onMessage(MessageHandler cb)
+    {
+        mTransport->onMessage(std::move(cb));
+    }
+
+    void onConnected(ConnectedHandler cb)
+    {
+        mTransport->onConnected(std::move(cb));
+    }
+
+    void onConnectionLost(ConnectionLostHandler cb)
+    {
+        mTransport->onConnectionLost(std::move(cb));
+    }
+private:
+    std::unique_ptr<MqttTransport> mTransport;
+};
+
+
 #endif //GROWSTUDIO_MQTTCLIENT_H
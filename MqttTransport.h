@@ -0,0 +1,56 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_MQTTTRANSPORT_H
+#define GROWSTUDIO_MQTTTRANSPORT_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+
+
+const std::string telemetryTopic("ReservoirController/telemetry");
+const std::string responseTopic("ReservoirController/rpc/response");
+const std::string requestTopic("ReservoirController/rpc/request");
+
+const int	QOS = 1;
+const int	N_RETRY_ATTEMPTS = 5;
+
+// First level of a topic, which names the device
+inline std::string_view deviceOf(std::string_view topic)
+{
+    return topic.substr(0, topic.find('/'));
+}
+
+// Topic and payload are only valid for the duration of the call.
+using MessageHandler = std::function<void(std::string_view topic, std::string_view payload)>;
+using ConnectedHandler = std::function<void()>;
+using ConnectionLostHandler = std::function<void()>;
+
+enum class MqttBackend
+{
+    Paho,
+    Asio
+};
+
+/**
+ * Connection to a MQTT broker. MqttClient owns one of these and forwards its API to it,
+ * so the underlying implementation can be chosen at runtime.
+ */
+class MqttTransport
+{
+public:
+    virtual ~MqttTransport() = default;
+    virtual void connect() = 0;
+    [[nodiscard]] virtual bool isConnected() const = 0;
+    virtual void publish(const std::string& topic, const std::string& message) = 0;
+    // Subscriptions are kept and renewed whenever the connection is (re)established
+    virtual void subscribe(const std::string& topic) = 0;
+    virtual void onMessage(MessageHandler cb) = 0;
+    virtual void onConnected(ConnectedHandler cb) = 0;
+    virtual void onConnectionLost(ConnectionLostHandler cb) = 0;
+};
+
+
+#endif //GROWSTUDIO_MQTTTRANSPORT_H
@@ -9,13 +9,17 @@
 #include <chrono>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Window/Event.hpp>
+#include "FrameArena.h"
 
 
 
 class Plugin {
 public:
     virtual ~Plugin() = default;
-    virtual void onGUI() = 0;
+    // Called every frame before onGUI, for work that isn't drawing (e.g. handling received messages)
+    virtual void onUpdate() {}
+    // Transient data such as labels can be allocated from arena, which is reset every frame
+    virtual void onGUI(FrameArena& arena) = 0;
 };
 
 
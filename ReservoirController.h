@@ -7,20 +7,26 @@
 
 #include "Plugin.h"
 #include "imgui.h"
-#include <deque>
 #include <fmt/format.h>
+#include <fmt/chrono.h>
 #include <nlohmann/json.hpp>
 #include <functional>
-#include "MqttClient.h"
-#include "ApplicationError.h"
+#include "ShardedMqttClient.h"
+#include "EventJournal.h"
+#include "CompressedSeries.h"
+#include "TelemetryCoalescer.h"
 #include <map>
 #include "imgui_stdlib.h"
 #include <fstream>
+#include <optional>
+#include <limits>
 
 
 const std::string SERVER_ADDRESS("test.mosquitto.org:1883");
 const std::string CLIENT_ID("reservoir-controller");
 const std::string configFile{"ReservoirController.json"};
+// Device name used for events raised by GrowStudio itself
+const std::string localDevice{"GrowStudio"};
 
 static constexpr std::size_t maxDoserCount{100};
 
@@ -28,6 +34,28 @@ static constexpr std::size_t maxDoserCount{100};
 class ReservoirController : public Plugin
 {
     using ResponseHandler = std::function<void(const nlohmann::json& response)>;
+    struct Message
+    {
+        std::string topic;
+        nlohmann::json body;
+        // Telemetry readings, extracted on the network thread so storing them stays cheap
+        CompressedSeries::Clock::time_point received;
+        std::optional<float> ph;
+        std::optional<float> ec;
+    };
+    // Statistics over everything stored in a CompressedSeries and its newest samples
+    struct SeriesSummary
+    {
+        static constexpr std::size_t recentSize{500};
+        std::size_t count{};
+        float min{};
+        float max{};
+        float mean{};
+        std::chrono::minutes span{};
+        std::size_t bytes{};
+        std::array<float, recentSize> recent{};
+        int recentCount{};
+    };
     // Gui
     bool mValveIsOpen{false};
     int mUseID{true};
@@ -38,16 +66,35 @@ class ReservoirController : public Plugin
     float mCalibrationEC{0.0f};
     int mDosersCount{-1};
     std::map<int, std::string> mDoserNutrients;
-    // Telemetry
-    std::deque<float> mPHReadings{};
-    std::deque<float> mECReadings{};
-    static constexpr std::size_t readingsMax{100};
+    // Telemetry, stored at full rate and coalesced for display
+    static constexpr std::size_t readingsBlocksMax{512};
+    CompressedSeries mPHReadings{readingsBlocksMax};
+    CompressedSeries mECReadings{readingsBlocksMax};
+    int mDisplayIntervalMs;
+    std::size_t mDisplayBacklogLimit;
+    TelemetryCoalescer mLiveView;
+    // Messages fully handled per frame. Telemetry beyond that is only stored, not shown.
+    std::size_t mMessagesPerFrame;
+    // Only while the history is shown, and throttled as decoding covers hours of samples
+    static constexpr auto historyRefreshTime{std::chrono::seconds{1}};
+    SeriesSummary mPHHistory;
+    SeriesSummary mECHistory;
+    std::chrono::steady_clock::time_point mHistoryRefreshed{};
     std::string mLiquidLevel{"empty"};
     // Messaging
-    MqttClient mClient;
-    std::deque<mqtt::const_message_ptr> mMessages;
+    MqttBackend mBackend;
+    std::size_t mShards;
+    ShardedMqttClient<Message> mClient;
     std::map<int, ResponseHandler> mResponseHandlers;
-    std::deque<ApplicationError> mErrors;
+    // Events
+    static constexpr auto errorAcuteTime{std::chrono::seconds{3}};
+    EventJournal mEvents;
+    std::vector<EventJournal::Seq> mEventView;
+    std::uint64_t mEventViewVersion{};
+    // Kept by name, the journal reuses the ids of devices whose entries are all evicted
+    std::optional<std::string> mEventDevice;
+    bool mFilterEventCode{false};
+    int mEventCode{};
 
     void openValve() {
         mClient.publish(requestTopic,
@@ -140,22 +187,29 @@ class ReservoirController : public Plugin
         mResponseHandlers[id] = std::move(handler);
     }
 
-    void handleTelemetry(const nlohmann::json& msg) {
-        if (msg.contains("ph")) {
-            mPHReadings.push_back(msg["ph"]);
-            if (mPHReadings.size() > readingsMax) {
-                mPHReadings.pop_front();
-            }
+    void storeTelemetry(const Message& msg) {
+        if (msg.ph) {
+            mPHReadings.push(msg.received, *msg.ph);
+        }
+        if (msg.ec) {
+            mECReadings.push(msg.received, *msg.ec);
+        }
+    }
+
+    void handleTelemetry(std::string_view device, const Message& msg) {
+        storeTelemetry(msg);
+        if (msg.ph) {
+            mLiveView.add(device, "ph", *msg.ph);
         }
-        if (msg.contains("ec")) {
-            mECReadings.push_back(msg["ec"]);
+        if (msg.ec) {
+            mLiveView.add(device, "ec", *msg.ec);
         }
-        if (msg.contains("liquidLevel")) {
-            mLiquidLevel = msg["liquidLevel"];
+        if (msg.body.contains("liquidLevel")) {
+            mLiquidLevel = msg.body["liquidLevel"];
         }
     }
 
-    void handleResponse(const nlohmann::json& response) {
+    void handleResponse(std::string_view device, const nlohmann::json& response) {
         if (!response.contains("id")) {
             std::cerr << "Response does not contain id" << std::endl;
             return;
@@ -166,64 +220,245 @@ class ReservoirController : public Plugin
         }
 
         if (response.contains("error")) {
-            mErrors.emplace_back(response["error"].value("code", -1), response["error"].value("message", "No message"));
+            mEvents.record(device, response["error"].value("code", -1), response["error"].value("message", "No message"));
         }
     }
 
-    void handleMessages()
+    // Runs on the receiving shard's network thread
+    static std::optional<Message> decodeMessage(std::string_view topic, std::string_view payload)
     {
-        while (!mMessages.empty())
-        {
-            auto msg = mMessages.front();
-
-            if (msg->get_topic() == telemetryTopic) {
-                handleTelemetry(nlohmann::json::parse(msg->get_payload()));
-            }
-            else if (msg->get_topic() == responseTopic) {
-                handleResponse(nlohmann::json::parse(msg->get_payload()));
+        try {
+            Message msg{std::string{topic}, nlohmann::json::parse(payload), CompressedSeries::Clock::now()};
+            if (msg.topic == telemetryTopic) {
+                if (msg.body.contains("ph")) {
+                    msg.ph = msg.body["ph"].get<float>();
+                }
+                if (msg.body.contains("ec")) {
+                    msg.ec = msg.body["ec"].get<float>();
+                }
             }
+            return msg;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Invalid message on " << topic << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
 
-            mMessages.pop_front();
+    void handleMessage(const Message& msg)
+    {
+        if (msg.topic == telemetryTopic) {
+            handleTelemetry(deviceOf(msg.topic), msg);
+        }
+        else if (msg.topic == responseTopic) {
+            handleResponse(deviceOf(msg.topic), msg.body);
         }
     }
 
-public:
-    ReservoirController()
-    : mClient(SERVER_ADDRESS, CLIENT_ID)
+    // Handles up to mMessagesPerFrame messages fully. Telemetry past that is only stored, so under load
+    // the live view thins out while storage stays full-rate. Returns how many telemetry messages the live view missed.
+    std::size_t handleMessages()
     {
-        mClient.onMessage([this](mqtt::const_message_ptr msg) {
-            mMessages.push_back(msg);
+        mClient.drain([this](const Message& msg) {
+            handleMessage(msg);
+        }, mMessagesPerFrame);
+
+        std::size_t storedOnly{};
+        mClient.drain([this, &storedOnly](const Message& msg) {
+            if (msg.topic == telemetryTopic) {
+                storeTelemetry(msg);
+                ++storedOnly;
+            }
+            else {
+                handleMessage(msg);
+            }
         });
+        return storedOnly;
+    }
 
-        mClient.onConnected([this]() {
-            getDosersCount();
+    static void summarize(const CompressedSeries& series, SeriesSummary& summary)
+    {
+        summary.count = series.size();
+        summary.bytes = series.bytes();
+        summary.recentCount = static_cast<int>(series.copyLast(summary.recent));
+        if (series.empty()) {
+            return;
+        }
+
+        float min{std::numeric_limits<float>::max()};
+        float max{std::numeric_limits<float>::lowest()};
+        double sum{};
+        std::optional<CompressedSeries::Clock::time_point> first;
+        series.forEach([&](const CompressedSeries::Sample& sample) {
+            if (!first) {
+                first = sample.time;
+            }
+            min = std::min(min, sample.value);
+            max = std::max(max, sample.value);
+            sum += sample.value;
         });
+        summary.min = min;
+        summary.max = max;
+        summary.mean = static_cast<float>(sum / static_cast<double>(summary.count));
+        summary.span = std::chrono::duration_cast<std::chrono::minutes>(series.back().time - *first);
+    }
 
-        mClient.connect();
+    void refreshHistory()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - mHistoryRefreshed < historyRefreshTime) {
+            return;
+        }
+        mHistoryRefreshed = now;
+        summarize(mPHReadings, mPHHistory);
+        summarize(mECReadings, mECHistory);
+    }
+
+    static void showHistory(FrameArena& arena, const char* name, const SeriesSummary& summary)
+    {
+        if (summary.count == 0) {
+            return;
+        }
+        ImGui::PlotLines(arena.format("{} last {} samples", name, summary.recentCount), summary.recent.data(), summary.recentCount);
+        ImGui::Text("%zu samples over %d min: min %.2f max %.2f mean %.2f (%zu KiB)",
+                    summary.count, static_cast<int>(summary.span.count()), summary.min, summary.max, summary.mean, summary.bytes / 1024);
+    }
+
+    static void plotChannel(FrameArena& arena, const char* name, const TelemetryCoalescer::Channel& channel)
+    {
+        const auto& latest = channel.published;
+        ImGui::PlotLines(arena.format("{} [{:.2f}]", name, latest.last), channel.history.data(), channel.historyCount, channel.historyOffset);
+        ImGui::Text("min %.2f max %.2f (%zu samples)", latest.min, latest.max, latest.count);
+    }
+
+    void showEvents(FrameArena& arena)
+    {
+        if (!ImGui::CollapsingHeader("Events")) {
+            return;
+        }
 
+        bool filterChanged{false};
+        ImGui::SetNextItemWidth(200);
+        if (ImGui::BeginCombo("Device", mEventDevice ? mEventDevice->c_str() : "All devices")) {
+            if (ImGui::Selectable("All devices", !mEventDevice)) {
+                mEventDevice.reset();
+                filterChanged = true;
+            }
+            mEvents.forEachDevice([&](std::string_view device) {
+                if (ImGui::Selectable(arena.copy(device), mEventDevice == device)) {
+                    mEventDevice = device;
+                    filterChanged = true;
+                }
+            });
+            ImGui::EndCombo();
+        }
+        ImGui::SameLine();
+        filterChanged |= ImGui::Checkbox("Code", &mFilterEventCode);
+        if (mFilterEventCode) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100);
+            filterChanged |= ImGui::InputInt("##code", &mEventCode);
+        }
+
+        if (filterChanged || mEventViewVersion != mEvents.version()) {
+            EventJournal::Filter filter;
+            if (mEventDevice) {
+                filter.device = mEvents.deviceID(*mEventDevice);
+            }
+            if (mFilterEventCode) {
+                filter.code = mEventCode;
+            }
+            // A selected device without entries left matches nothing
+            if (mEventDevice && !filter.device) {
+                mEventView.clear();
+            }
+            else {
+                mEvents.query(filter, mEventView);
+            }
+            mEventViewVersion = mEvents.version();
+        }
+
+        ImGui::Text("%zu of %zu entries", mEventView.size(), mEvents.size());
+        ImGui::BeginChild("EventList", ImVec2(0, 200), true);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(mEventView.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& event = mEvents.event(mEventView[row]);
+                const auto time = fmt::localtime(EventJournal::Clock::to_time_t(event.first));
+                ImGui::TextUnformatted(arena.format("{:%H:%M:%S} {} Error[{}]: {}", time, mEvents.device(event), event.code, mEvents.message(event)));
+                if (event.count > 1) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("x%u", event.count);
+                }
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    static nlohmann::json loadConfig()
+    {
         try {
             std::ifstream ifs(configFile);
             nlohmann::json cfg;
             ifs >> cfg;
-            if (cfg.contains("doserNutrients")) {
-                mDoserNutrients = cfg["doserNutrients"];
-            }
-            if (cfg.contains("useID")) {
-                mUseID = cfg["useID"];
-            }
+            return cfg;
         }
         catch(const std::exception& e) {
             std::cerr << "Unable to load config" << std::endl;
+            return nlohmann::json::object();
         }
     }
 
+    static MqttBackend backendFromConfig(const nlohmann::json& cfg)
+    {
+        return cfg.value("mqttBackend", "paho") == "asio" ? MqttBackend::Asio : MqttBackend::Paho;
+    }
+
+    explicit ReservoirController(const nlohmann::json& cfg)
+    : mDisplayIntervalMs{cfg.value("displayIntervalMs", 100)},
+      mDisplayBacklogLimit{cfg.value("displayBacklogLimit", std::size_t{1000})},
+      mLiveView(std::chrono::milliseconds{mDisplayIntervalMs}, mDisplayBacklogLimit),
+      mMessagesPerFrame{cfg.value("messagesPerFrame", std::size_t{5000})},
+      mBackend{backendFromConfig(cfg)}, mShards{cfg.value("mqttShards", std::size_t{1})},
+      mClient(SERVER_ADDRESS, CLIENT_ID, mShards, mBackend, &ReservoirController::decodeMessage)
+    {
+        if (cfg.contains("doserNutrients")) {
+            mDoserNutrients = cfg["doserNutrients"];
+        }
+        if (cfg.contains("useID")) {
+            mUseID = cfg["useID"];
+        }
+
+        mEventView.reserve(mEvents.capacity());
+
+        mClient.subscribe(telemetryTopic);
+        mClient.subscribe(responseTopic);
+
+        mClient.onConnected([this]() {
+            getDosersCount();
+        });
+
+        mClient.connect();
+    }
+
+public:
+    ReservoirController()
+    : ReservoirController(loadConfig())
+    {}
+
     ~ReservoirController() override
     {
         std::ofstream ofs(configFile, std::ios::out);
         try {
             nlohmann::json cfg{
                     {"doserNutrients", mDoserNutrients},
-                    {"useID", mUseID}
+                    {"useID", mUseID},
+                    {"mqttBackend", mBackend == MqttBackend::Asio ? "asio" : "paho"},
+                    {"mqttShards", mShards},
+                    {"displayIntervalMs", mDisplayIntervalMs},
+                    {"displayBacklogLimit", mDisplayBacklogLimit},
+                    {"messagesPerFrame", mMessagesPerFrame}
             };
             ofs << cfg;
         }
@@ -232,7 +467,12 @@ public:
         }
     }
 
-    void onGUI() override
+    void onUpdate() override
+    {
+        mLiveView.update(handleMessages());
+    }
+
+    void onGUI(FrameArena& arena) override
     {
         ImGui::Begin("ReservoirController", NULL, ImGuiWindowFlags_MenuBar);
 
@@ -247,11 +487,11 @@ public:
                 if (ImGui::BeginMenu("Configure dosers")) {
                     ImGui::SeparatorText("Doser-nutrients");
 
-                    std::erase_if(mDoserNutrients, [](const auto& elem) {
+                    std::erase_if(mDoserNutrients, [&arena](const auto& elem) {
                         const auto& [doserID, nutrient] = elem;
                         ImGui::Text("doserID: %d, nutrient: %s", doserID, nutrient.c_str());
                         ImGui::SameLine();
-                        return ImGui::Button(fmt::format("Delete##{}", doserID).c_str());
+                        return ImGui::Button(arena.format("Delete##{}", doserID));
                     });
 
                     ImGui::SeparatorText("Add doser-nutrient");
@@ -267,7 +507,7 @@ public:
                                 mDoserNutrients[pumpID] = nutrient;
                             }
                             else {
-                                mErrors.emplace_back(0, "All dosers are used. Remove existing nutrients to add create new");
+                                mEvents.record(localDevice, 0, "All dosers are used. Remove existing nutrients to add create new");
                             }
                         }
                         ImGui::SameLine();
@@ -290,18 +530,28 @@ public:
             ImGui::SeparatorText("Status");
 
             // Status
-            if (!mPHReadings.empty()) {
-                std::vector<float> readings{mPHReadings.begin(), mPHReadings.end()};
-                ImGui::PlotLines(fmt::format("PH [{:.2f}]", mPHReadings.back()).c_str(), &readings.front(), static_cast<int>(readings.size()));
+            const auto device = deviceOf(telemetryTopic);
+            if (const auto* ph = mLiveView.channel(device, "ph")) {
+                plotChannel(arena, "PH", *ph);
             }
 
-            if (!mECReadings.empty()) {
-                std::vector<float> readings{mECReadings.begin(), mECReadings.end()};
-                ImGui::PlotLines(fmt::format("EC [{:.2f}]", mECReadings.back()).c_str(), &readings.front(), static_cast<int>(readings.size()));
+            if (const auto* ec = mLiveView.channel(device, "ec")) {
+                plotChannel(arena, "EC", *ec);
+            }
+
+            if (ImGui::TreeNode("History")) {
+                refreshHistory();
+                showHistory(arena, "PH", mPHHistory);
+                showHistory(arena, "EC", mECHistory);
+                ImGui::TreePop();
             }
 
             ImGui::Text("LiquidLevel: %s", mLiquidLevel.c_str());
-            ImGui::Text("Dosers count: %s", (mDosersCount == -1) ? "unknown" : std::to_string(mDosersCount).c_str());
+            if (mDosersCount == -1) {
+                ImGui::Text("Dosers count: unknown");
+            } else {
+                ImGui::Text("Dosers count: %d", mDosersCount);
+            }
 
             ImGui::NewLine();
             ImGui::SeparatorText("Valve");
@@ -333,7 +583,7 @@ public:
             }
             else {
                 for (const auto& [id, nutrient] : mDoserNutrients) {
-                    ImGui::SliderFloat(fmt::format("{} {}", nutrient.c_str(), id).c_str(), &mDoseAmounts[id], 0.0f, 100.0f);
+                    ImGui::SliderFloat(arena.format("{} {}", nutrient, id), &mDoseAmounts[id], 0.0f, 100.0f);
                 }
 
                 if (ImGui::Button("Dose")) {
@@ -397,18 +647,17 @@ public:
             }
 
             // Display error
-            if (!mErrors.empty()) {
-                if (mErrors.front().isAcute()) {
-                    ImGui::Text("Error[%d]: %s ", mErrors.front().code(), mErrors.front().message().c_str());
-                } else {
-                    mErrors.pop_front();
-                }
+            if (const auto* latest = mEvents.latest(); latest && EventJournal::Clock::now() - latest->last < errorAcuteTime) {
+                const auto message = mEvents.message(*latest);
+                ImGui::Text("Error[%d]: %.*s ", latest->code, static_cast<int>(message.size()), message.data());
             }
         }
         else {
             ImGui::Text("Not Connected");
         }
 
+        showEvents(arena);
+
         ImGui::End();
 
         ImGui::ShowDemoWindow();
@@ -0,0 +1,278 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_SHARDEDMQTTCLIENT_H
+#define GROWSTUDIO_SHARDEDMQTTCLIENT_H
+
+#include "MqttClient.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * Consistent hash ring mapping keys to shard indices. Every shard owns a number of virtual nodes
+ * on the ring, so changing the shard count only moves the keys of the added or removed shard.
+ */
+class HashRing
+{
+public:
+    explicit HashRing(std::size_t shards, std::size_t virtualNodes = 64)
+    {
+        mRing.reserve(shards * virtualNodes);
+        for (std::size_t shard = 0; shard < shards; ++shard) {
+            for (std::size_t node = 0; node < virtualNodes; ++node) {
+                const auto name = std::to_string(shard) + '#' + std::to_string(node);
+                mRing.push_back({hash(name), shard});
+            }
+        }
+        std::sort(mRing.begin(), mRing.end());
+    }
+
+    [[nodiscard]] std::size_t shardOf(std::string_view key) const
+    {
+        if (mRing.empty()) {
+            return 0;
+        }
+        auto it = std::lower_bound(mRing.begin(), mRing.end(), std::pair{hash(key), std::size_t{0}});
+        return it == mRing.end() ? mRing.front().second : it->second;
+    }
+
+    // FNV-1a, stable between runs unlike std::hash. The murmur3 finalizer mixes the last characters
+    // into the high bits, without it keys differing only at the end land next to each other on the ring.
+    static std::uint64_t hash(std::string_view key)
+    {
+        std::uint64_t h{0xcbf29ce484222325};
+        for (const char c : key) {
+            h ^= static_cast<std::uint8_t>(c);
+            h *= 0x100000001b3;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    std::vector<std::pair<std::uint64_t, std::size_t>> mRing;
+};
+
+
+/**
+ * Spreads MQTT traffic over several broker connections. Topics are assigned to a connection by
+ * their first level (the device name), so every message of a device arrives over the same
+ * connection and in order. Wildcards in the first level are therefore not supported.
+ *
+ * Messages are decoded into T on the receiving connection's own thread and queued per shard.
+ * The GUI thread collects them with drain(), which can be limited to a number of items per call.
+ * Whatever is left stays queued in order and is reported by backlog().
+ *
+ * Only shards that some topic maps to are connected, so sharding only spreads load when there are
+ * several devices. A single device (such as ReservoirController today) always uses one connection
+ * whatever the shard count.
+ */
+template<typename T>
+class ShardedMqttClient
+{
+public:
+    // Called on the shard's network thread. Returning std::nullopt drops the message.
+    using Decoder = std::function<std::optional<T>(std::string_view topic, std::string_view payload)>;
+
+    ShardedMqttClient(const std::string& server, const std::string& clientID, std::size_t shards, MqttBackend backend, Decoder decoder)
+    : mRing(std::max<std::size_t>(shards, 1)), mDecoder(std::move(decoder))
+    {
+        shards = std::max<std::size_t>(shards, 1);
+        for (std::size_t i = 0; i < shards; ++i) {
+            // The first shard keeps the plain client ID so its persistent session survives changing the shard count
+            const auto id = i == 0 ? clientID : clientID + '-' + std::to_string(i);
+            auto shard = std::make_unique<Shard>(server, id, backend);
+            auto& s = *shard;
+
+            s.client.onMessage([this, &s](std::string_view topic, std::string_view payload) {
+                auto decoded = mDecoder(topic, payload);
+                if (decoded) {
+                    std::lock_guard lock{s.mutex};
+                    s.decoded.push_back(std::move(*decoded));
+                    mBacklog.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+            s.client.onConnected([this]() {
+                std::lock_guard lock{mConnectedMutex};
+                if (isConnected()) {
+                    mConnectedHandler();
+                }
+            });
+
+            s.client.onConnectionLost([this]() {
+                mConnectionLostHandler();
+            });
+
+            mShards.push_back(std::move(shard));
+        }
+    }
+
+    // Connects every shard that has topics. Shards that get their first topic later connect then.
+    void connect()
+    {
+        mStarted = true;
+        std::size_t active{};
+        for (auto& shard : mShards) {
+            if (shard->active) {
+                shard->client.connect();
+                ++active;
+            }
+        }
+        if (active < mShards.size()) {
+            std::cout << mShards.size() << " shards configured, " << active << " in use by the subscribed devices" << std::endl;
+        }
+    }
+
+    // True when every shard in use is connected
+    [[nodiscard]] bool isConnected() const
+    {
+        bool any{false};
+        for (const auto& shard : mShards) {
+            if (shard->active) {
+                if (!shard->client.isConnected()) {
+                    return false;
+                }
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    void publish(const std::string& topic, const std::string& message)
+    {
+        use(shardOf(topic)).client.publish(topic, message);
+    }
+
+    void subscribe(const std::string& topic)
+    {
+        use(shardOf(topic)).client.subscribe(topic);
+    }
+
+    // Called once all shards in use are connected
+    void onConnected(ConnectedHandler cb)
+    {
+        mConnectedHandler = std::move(cb);
+    }
+
+    // Called when any shard in use loses its connection
+    void onConnectionLost(ConnectionLostHandler cb)
+    {
+        mConnectionLostHandler = std::move(cb);
+    }
+
+    // Calls f(T&) for queued items in arrival order per device, at most maxItems in total.
+    // The budget is split evenly over the shards that have items, and what a shard doesn't use
+    // goes to the others. Returns the number of items still queued.
+    template<typename F>
+    std::size_t drain(F&& f, std::size_t maxItems = std::numeric_limits<std::size_t>::max())
+    {
+        for (auto& shard : mShards) {
+            if (shard->next == shard->inbox.size()) {
+                shard->inbox.clear();
+                shard->next = 0;
+                std::lock_guard lock{shard->mutex};
+                std::swap(shard->decoded, shard->inbox);
+            }
+        }
+
+        // Every round either hands out items or finds no shard with any left
+        while (maxItems > 0) {
+            const auto busy = static_cast<std::size_t>(std::count_if(mShards.begin(), mShards.end(), [](const auto& shard) {
+                return shard->next < shard->inbox.size();
+            }));
+            if (busy == 0) {
+                break;
+            }
+
+            const auto share = std::max<std::size_t>(maxItems / busy, 1);
+            for (auto& shard : mShards) {
+                const auto count = std::min({shard->inbox.size() - shard->next, share, maxItems});
+                for (std::size_t i = 0; i < count; ++i) {
+                    f(shard->inbox[shard->next++]);
+                }
+                mBacklog.fetch_sub(count, std::memory_order_relaxed);
+                maxItems -= count;
+            }
+        }
+        return backlog();
+    }
+
+    // Items decoded but not yet drained. Safe to call from any thread, including from the decoder.
+    [[nodiscard]] std::size_t backlog() const
+    {
+        return mBacklog.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t shardCount() const
+    {
+        return mShards.size();
+    }
+
+    // Shards that carry at least one topic
+    [[nodiscard]] std::size_t activeShardCount() const
+    {
+        return static_cast<std::size_t>(std::count_if(mShards.begin(), mShards.end(), [](const auto& shard) {
+            return shard->active.load();
+        }));
+    }
+
+    [[nodiscard]] std::size_t shardOf(std::string_view topic) const
+    {
+        return mRing.shardOf(deviceOf(topic));
+    }
+
+private:
+    struct Shard
+    {
+        Shard(const std::string& server, const std::string& clientID, MqttBackend backend)
+        : client(server, clientID, backend)
+        {}
+
+        std::mutex mutex;
+        std::vector<T> decoded;
+        // Only touched by drain(), keeps its capacity between frames. Items before next are done.
+        std::vector<T> inbox;
+        std::size_t next{};
+        // Set once a topic maps to this shard, read from the network threads
+        std::atomic<bool> active{false};
+        // Last, so its network thread is stopped before the members its handlers use are destroyed
+        MqttClient client;
+    };
+
+    Shard& use(std::size_t index)
+    {
+        auto& shard = *mShards[index];
+        if (!shard.active.exchange(true) && mStarted) {
+            shard.client.connect();
+        }
+        return shard;
+    }
+
+    HashRing mRing;
+    Decoder mDecoder;
+    std::mutex mConnectedMutex;
+    bool mStarted{false};
+    std::atomic<std::size_t> mBacklog{0};
+    ConnectedHandler mConnectedHandler{[](){}};
+    ConnectionLostHandler mConnectionLostHandler{[](){}};
+    // Last, so the shards' network threads are stopped before anything they call into is destroyed
+    std::vector<std::unique_ptr<Shard>> mShards;
+};
+
+
+#endif //GROWSTUDIO_SHARDEDMQTTCLIENT_H
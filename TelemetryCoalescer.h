@@ -0,0 +1,141 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+#ifndef GROWSTUDIO_TELEMETRYCOALESCER_H
+#define GROWSTUDIO_TELEMETRYCOALESCER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Live view of telemetry. Samples are folded per device and channel into an aggregate
+ * (last, min, max, count) which is published once per display interval, so the GUI only
+ * changes at that rate however fast devices publish. The caller bounds the samples it adds per frame
+ * and reports the ones it had to leave out. When more than backlogLimit were left out during an
+ * interval, the next one is stretched in proportion (up to maxInterval), and it returns to the
+ * configured interval once everything is added again.
+ */
+class TelemetryCoalescer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t historySize{100};
+
+    struct Aggregate
+    {
+        float last{};
+        float min{std::numeric_limits<float>::max()};
+        float max{std::numeric_limits<float>::lowest()};
+        std::size_t count{};
+    };
+
+    // Published state of one channel. history is a ring buffer of the last value of each interval,
+    // laid out for ImGui::PlotLines(label, history.data(), historyCount, historyOffset).
+    struct Channel
+    {
+        Aggregate current;
+        Aggregate published;
+        std::array<float, historySize> history{};
+        int historyCount{};
+        int historyOffset{};
+    };
+
+    explicit TelemetryCoalescer(Clock::duration interval = std::chrono::milliseconds{100},
+                                std::size_t backlogLimit = 1000,
+                                Clock::duration maxInterval = std::chrono::seconds{2})
+    : mBaseInterval{interval}, mInterval{interval}, mMaxInterval{std::max(interval, maxInterval)}, mBacklogLimit{backlogLimit}
+    {}
+
+    void add(std::string_view device, std::string_view name, float value)
+    {
+        auto deviceIt = mDevices.find(device);
+        if (deviceIt == mDevices.end()) {
+            deviceIt = mDevices.emplace(std::string{device}, Channels{}).first;
+        }
+        auto channelIt = deviceIt->second.find(name);
+        if (channelIt == deviceIt->second.end()) {
+            channelIt = deviceIt->second.emplace(std::string{name}, Channel{}).first;
+        }
+
+        auto& aggregate = channelIt->second.current;
+        aggregate.last = value;
+        aggregate.min = std::min(aggregate.min, value);
+        aggregate.max = std::max(aggregate.max, value);
+        ++aggregate.count;
+    }
+
+    // Counts the samples left out since the last call and publishes the pending aggregates once the
+    // display interval has passed. Returns true when it published.
+    bool update(std::size_t missed, Clock::time_point now = Clock::now())
+    {
+        mMissed += missed;
+        if (now - mLastPublish < mInterval) {
+            return false;
+        }
+        mLastPublish = now;
+
+        const auto scale = std::max(1.0, static_cast<double>(mMissed) / static_cast<double>(std::max<std::size_t>(mBacklogLimit, 1)));
+        mInterval = std::min(std::chrono::duration_cast<Clock::duration>(mBaseInterval * scale), mMaxInterval);
+        mMissed = 0;
+
+        for (auto& [device, channels] : mDevices) {
+            for (auto& [name, channel] : channels) {
+                if (channel.current.count == 0) {
+                    continue;
+                }
+                channel.published = channel.current;
+                channel.current = Aggregate{};
+
+                const auto index = (channel.historyOffset + channel.historyCount) % static_cast<int>(historySize);
+                channel.history[index] = channel.published.last;
+                if (channel.historyCount < static_cast<int>(historySize)) {
+                    ++channel.historyCount;
+                }
+                else {
+                    channel.historyOffset = (channel.historyOffset + 1) % static_cast<int>(historySize);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Nullptr until something has been published for the channel
+    [[nodiscard]] const Channel* channel(std::string_view device, std::string_view name) const
+    {
+        const auto deviceIt = mDevices.find(device);
+        if (deviceIt == mDevices.end()) {
+            return nullptr;
+        }
+        const auto channelIt = deviceIt->second.find(name);
+        if (channelIt == deviceIt->second.end() || channelIt->second.historyCount == 0) {
+            return nullptr;
+        }
+        return &channelIt->second;
+    }
+
+    [[nodiscard]] Clock::duration interval() const
+    {
+        return mInterval;
+    }
+
+private:
+    using Channels = std::map<std::string, Channel, std::less<>>;
+
+    std::map<std::string, Channels, std::less<>> mDevices;
+    Clock::duration mBaseInterval;
+    Clock::duration mInterval;
+    Clock::duration mMaxInterval;
+    std::size_t mBacklogLimit;
+    std::size_t mMissed{};
+    Clock::time_point mLastPublish{};
+};
+
+
+#endif //GROWSTUDIO_TELEMETRYCOALESCER_H
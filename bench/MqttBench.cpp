@@ -0,0 +1,304 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+// Telemetry ingest rate and request/response round trip of the MQTT backends, measured against a
+// local broker stand-in so that both backends see exactly the same traffic.
+// Usage: MqttBench [messages] [roundTrips] [asio|paho|both]
+
+#include "MqttClient.h"
+#include <asio.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+using BenchClock = std::chrono::steady_clock;
+using tcp = asio::ip::tcp;
+
+const std::string telemetryPayload{R"({"ph":6.23,"ec":1.41,"liquidLevel":"full"})"};
+
+/**
+ * Just enough of a MQTT broker for one client: CONNECT, SUBSCRIBE and PINGREQ are acknowledged,
+ * subscribing to the telemetry topic starts a stream of telemetry messages, and every request is
+ * answered on the response topic with the same payload.
+ */
+class BrokerStandIn
+{
+public:
+    explicit BrokerStandIn(std::size_t telemetryCount)
+    : mAcceptor(mIo, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)), mSocket(mIo),
+      mTelemetryCount{telemetryCount}, mIn(64 * 1024)
+    {
+        mAcceptor.async_accept(mSocket, [this](const asio::error_code& error) {
+            if (!error) {
+                mSocket.set_option(tcp::no_delay(true));
+                read();
+            }
+        });
+        mThread = std::thread([this]() { mIo.run(); });
+    }
+
+    ~BrokerStandIn()
+    {
+        mIo.stop();
+        mThread.join();
+    }
+
+    [[nodiscard]] std::string address() const
+    {
+        return "tcp://127.0.0.1:" + std::to_string(mAcceptor.local_endpoint().port());
+    }
+
+private:
+    static constexpr std::size_t writeChunkSize{64 * 1024};
+
+    static std::uint16_t readU16(const char* data)
+    {
+        return static_cast<std::uint16_t>((static_cast<std::uint8_t>(data[0]) << 8) | static_cast<std::uint8_t>(data[1]));
+    }
+
+    static void appendPublish(std::string& out, std::string_view topic, std::string_view payload)
+    {
+        out.push_back(0x30);
+        auto length = 2 + topic.size() + payload.size();
+        do {
+            auto byte = static_cast<std::uint8_t>(length % 128);
+            length /= 128;
+            out.push_back(static_cast<char>(length > 0 ? byte | 0x80 : byte));
+        } while (length > 0);
+        out.push_back(static_cast<char>(topic.size() >> 8));
+        out.push_back(static_cast<char>(topic.size() & 0xff));
+        out.append(topic);
+        out.append(payload);
+    }
+
+    void read()
+    {
+        if (mIn.size() - mInSize < 4096) {
+            mIn.resize(mIn.size() * 2);
+        }
+        mSocket.async_read_some(asio::buffer(mIn.data() + mInSize, mIn.size() - mInSize), [this](const asio::error_code& error, std::size_t n) {
+            if (error) {
+                return;
+            }
+            mInSize += n;
+            parse();
+            read();
+        });
+    }
+
+    void parse()
+    {
+        std::size_t offset{};
+        while (mInSize - offset >= 2) {
+            std::size_t length{};
+            std::size_t header{1};
+            bool complete{false};
+            for (unsigned shift = 0; header < 5 && offset + header < mInSize; shift += 7) {
+                const auto byte = static_cast<std::uint8_t>(mIn[offset + header++]);
+                length |= static_cast<std::size_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete || offset + header + length > mInSize) {
+                break;
+            }
+            handle(static_cast<std::uint8_t>(mIn[offset]), std::string_view{mIn.data() + offset + header, length});
+            offset += header + length;
+        }
+        std::memmove(mIn.data(), mIn.data() + offset, mInSize - offset);
+        mInSize -= offset;
+    }
+
+    void handle(std::uint8_t type, std::string_view body)
+    {
+        switch (type >> 4) {
+            case 1: // CONNECT
+                mOut.append({0x20, 0x02, 0x00, 0x00});
+                break;
+            case 3: { // PUBLISH
+                const auto topicLength = readU16(body.data());
+                const auto topic = body.substr(2, topicLength);
+                auto position = 2 + topicLength;
+                if (((type >> 1) & 0x03) > 0) {
+                    mOut.append({0x40, 0x02});
+                    mOut.append(body.substr(position, 2));
+                    position += 2;
+                }
+                if (topic == requestTopic) {
+                    appendPublish(mOut, responseTopic, body.substr(position));
+                }
+                break;
+            }
+            case 8: { // SUBSCRIBE
+                std::string granted;
+                std::size_t position{2};
+                while (position + 2 <= body.size()) {
+                    const auto topicLength = readU16(body.data() + position);
+                    if (body.substr(position + 2, topicLength) == telemetryTopic) {
+                        mTelemetryLeft = mTelemetryCount;
+                    }
+                    position += 2 + topicLength + 1;
+                    granted.push_back(static_cast<char>(QOS));
+                }
+                mOut.push_back(static_cast<char>(0x90));
+                mOut.push_back(static_cast<char>(2 + granted.size()));
+                mOut.append(body.substr(0, 2));
+                mOut.append(granted);
+                break;
+            }
+            case 12: // PINGREQ
+                mOut.append({static_cast<char>(0xd0), 0x00});
+                break;
+            default:
+                break;
+        }
+        write();
+    }
+
+    // Telemetry is generated a chunk at a time as the client keeps up
+    void write()
+    {
+        if (mWriteInFlight) {
+            return;
+        }
+        for (; mTelemetryLeft > 0 && mOut.size() < writeChunkSize; --mTelemetryLeft) {
+            appendPublish(mOut, telemetryTopic, telemetryPayload);
+        }
+        if (mOut.empty()) {
+            return;
+        }
+
+        std::swap(mOut, mWriting);
+        mWriteInFlight = true;
+        asio::async_write(mSocket, asio::buffer(mWriting), [this](const asio::error_code& error, std::size_t) {
+            mWriting.clear();
+            mWriteInFlight = false;
+            if (!error) {
+                write();
+            }
+        });
+    }
+
+    asio::io_context mIo;
+    tcp::acceptor mAcceptor;
+    tcp::socket mSocket;
+    std::thread mThread;
+    std::size_t mTelemetryCount;
+    std::size_t mTelemetryLeft{};
+    std::vector<char> mIn;
+    std::size_t mInSize{};
+    std::string mOut;
+    std::string mWriting;
+    bool mWriteInFlight{false};
+};
+
+
+struct Result
+{
+    double ingestRate;
+    double roundTripP50;
+    double roundTripP99;
+};
+
+template<typename Predicate>
+static bool waitFor(Predicate predicate, std::chrono::seconds timeout = std::chrono::seconds{60})
+{
+    const auto deadline = BenchClock::now() + timeout;
+    while (!predicate()) {
+        if (BenchClock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+static std::optional<Result> run(MqttBackend backend, std::size_t messages, std::size_t roundTrips)
+{
+    BrokerStandIn broker{messages};
+    std::atomic<std::size_t> telemetry{0};
+    std::atomic<std::size_t> responses{0};
+    Result result{};
+
+    // Declared after the stand-in so it is destroyed first and never sees the broker go away
+    MqttClient client(broker.address(), "GrowStudioBench", backend);
+    client.onMessage([&](std::string_view topic, std::string_view) {
+        if (topic == telemetryTopic) {
+            telemetry.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            responses.fetch_add(1, std::memory_order_release);
+        }
+    });
+    client.subscribe(telemetryTopic);
+    client.subscribe(responseTopic);
+
+    const auto start = BenchClock::now();
+    client.connect();
+    if (!waitFor([&]() { return telemetry.load(std::memory_order_relaxed) == messages; })) {
+        fmt::print(stderr, "Received {} of {} telemetry messages\n", telemetry.load(), messages);
+        return std::nullopt;
+    }
+    result.ingestRate = static_cast<double>(messages) / std::chrono::duration<double>(BenchClock::now() - start).count();
+
+    std::vector<double> latencies;
+    latencies.reserve(roundTrips);
+    for (std::size_t i = 0; i < roundTrips; ++i) {
+        const auto before = responses.load(std::memory_order_acquire);
+        const auto sent = BenchClock::now();
+        client.publish(requestTopic, R"({"jsonrpc":"2.0","id":1,"method":"dosersCount"})");
+        if (!waitFor([&]() { return responses.load(std::memory_order_acquire) > before; }, std::chrono::seconds{5})) {
+            fmt::print(stderr, "No response to request {}\n", i);
+            return std::nullopt;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(BenchClock::now() - sent).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    result.roundTripP50 = latencies.empty() ? 0.0 : latencies[latencies.size() / 2];
+    result.roundTripP99 = latencies.empty() ? 0.0 : latencies[latencies.size() * 99 / 100];
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const std::size_t roundTrips = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000;
+    const std::string_view backends = argc > 3 ? argv[3] : "both";
+
+    std::vector<std::pair<const char*, MqttBackend>> selected;
+    if (backends == "asio" || backends == "both") {
+        selected.emplace_back("asio", MqttBackend::Asio);
+    }
+    if (backends == "paho" || backends == "both") {
+        selected.emplace_back("paho", MqttBackend::Paho);
+    }
+
+    std::vector<std::pair<const char*, Result>> results;
+    for (const auto& [name, backend] : selected) {
+        const auto result = run(backend, messages, roundTrips);
+        if (!result) {
+            fmt::print(stderr, "{} backend failed\n", name);
+            return EXIT_FAILURE;
+        }
+        results.emplace_back(name, *result);
+    }
+
+    fmt::print("\n{} telemetry messages of {} bytes, {} round trips\n", messages, telemetryPayload.size(), roundTrips);
+    fmt::print("{:<8}{:>16}{:>16}{:>16}\n", "backend", "ingest msg/s", "rtt p50 us", "rtt p99 us");
+    for (const auto& [name, result] : results) {
+        fmt::print("{:<8}{:>16.0f}{:>16.1f}{:>16.1f}\n", name, result.ingestRate, result.roundTripP50, result.roundTripP99);
+    }
+    return EXIT_SUCCESS;
+}
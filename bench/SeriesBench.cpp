@@ -0,0 +1,91 @@
+//
+// Created by vaige on 18.10.2026.
+//
+
+// Storage and decode speed of CompressedSeries on telemetry shaped like ReservoirController's:
+// one pH reading per second with some jitter, rounded to the sensor's two decimals.
+// Usage: SeriesBench [samples]
+
+#include "CompressedSeries.h"
+#include <fmt/format.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+using BenchClock = std::chrono::steady_clock;
+
+// The same information stored raw: a 64-bit millisecond timestamp and a float
+constexpr std::size_t rawSampleBytes{sizeof(std::int64_t) + sizeof(float)};
+
+static double secondsSince(BenchClock::time_point start)
+{
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+    std::mt19937 rng{1};
+    std::normal_distribution<float> drift{0.0f, 0.005f};
+    std::uniform_int_distribution<int> jitter{-20, 20};
+    std::vector<CompressedSeries::Sample> reference;
+    reference.reserve(samples);
+    auto time = CompressedSeries::Clock::now();
+    float ph{6.2f};
+    for (std::size_t i = 0; i < samples; ++i) {
+        time += std::chrono::milliseconds{1000 + (i % 7 == 0 ? jitter(rng) : 0)};
+        ph += drift(rng);
+        reference.push_back({std::chrono::time_point_cast<std::chrono::milliseconds>(time), std::round(ph * 100.0f) / 100.0f});
+    }
+
+    // Every block holds far more than 32 samples, so nothing is dropped
+    CompressedSeries series{samples / 32 + 1};
+    auto start = BenchClock::now();
+    for (const auto& sample : reference) {
+        series.push(sample.time, sample.value);
+    }
+    const auto pushTime = secondsSince(start);
+
+    std::size_t index{};
+    bool matches{true};
+    series.forEach([&](const CompressedSeries::Sample& sample) {
+        matches &= index < reference.size() && sample.time == reference[index].time && sample.value == reference[index].value;
+        ++index;
+    });
+    if (!matches || index != samples) {
+        fmt::print(stderr, "Decoded series differs from the input\n");
+        return EXIT_FAILURE;
+    }
+
+    constexpr int decodeRounds{10};
+    double sum{};
+    start = BenchClock::now();
+    for (int round = 0; round < decodeRounds; ++round) {
+        series.forEach([&](const CompressedSeries::Sample& sample) {
+            sum += sample.value;
+        });
+    }
+    const auto decodeTime = secondsSince(start);
+
+    constexpr int copyRounds{1000};
+    std::vector<float> recent(500);
+    start = BenchClock::now();
+    for (int round = 0; round < copyRounds; ++round) {
+        sum += series.copyLast(recent);
+    }
+    const auto copyTime = secondsSince(start);
+
+    fmt::print("samples          {}\n", samples);
+    fmt::print("bytes/sample     {:.2f} (raw int64 ms timestamp + float: {})\n", static_cast<double>(series.bytes()) / static_cast<double>(samples), rawSampleBytes);
+    fmt::print("push             {:.1f} M samples/s\n", static_cast<double>(samples) / pushTime / 1e6);
+    fmt::print("forEach          {:.1f} M samples/s\n", decodeRounds * static_cast<double>(samples) / decodeTime / 1e6);
+    fmt::print("copyLast({})    {:.1f} us\n", recent.size(), copyTime / copyRounds * 1e6);
+    // Keeps the decode loops from being optimized away
+    fmt::print("checksum         {:.0f}\n", sum);
+    return EXIT_SUCCESS;
+}